@@ -16,6 +16,7 @@
     #include "ftxui/dom/table.hpp"
 
     #include "Job.hxx"
+    #include "JobRollup.hxx"
 
     namespace SJM
     {
@@ -25,6 +26,8 @@
             std::size_t nJobs,finishedJobs,runningJobs;
             unsigned long usedMem,reqMem;
             bool hasFinishedJobs;
+            std::size_t sampledJobs,unparsedSamples;
+            std::vector<HotNode> hotNodes;
         };
         
 
@@ -65,9 +68,11 @@
                  * @brief Create memory usage bar of finished jobs
                  * 
                  * @param jobVec collection of jobs obtained by JobManager
+                 * @param sampled number of running jobs whose memory usage was sampled with sstat
+                 * @param unparsed number of sstat output lines which could not be read
                  * @return ftxui::Element 
                  */
-                [[nodiscard]] ftxui::Element RenderMemUsage(unsigned avgUsed, unsigned requested) const;
+                [[nodiscard]] ftxui::Element RenderMemUsage(unsigned avgUsed, unsigned requested, std::size_t sampled, std::size_t unparsed) const;
                 /**
                  * @brief Create info bar with basic information about the batch jobs & ETA
                  * 
@@ -78,6 +83,13 @@
                  * @return ftxui::Element 
                  */
                 [[nodiscard]] ftxui::Element RenderBatchInfo(std::size_t finished, std::size_t running, std::size_t njobs, std::string user, std::string remTime, std::string eta, std::string avgRun) const;
+                /**
+                 * @brief Create panel listing the nodes with anomalous failure rates
+                 * 
+                 * @param hotNodes nodes flagged by JobRollup
+                 * @return ftxui::Element 
+                 */
+                [[nodiscard]] ftxui::Element RenderHotNodes(const std::vector<HotNode> &hotNodes) const;
                 [[nodiscard]] std::pair<std::string,ftxui::Color> GetColorByStatus(const Job::State state) const;
         };
 
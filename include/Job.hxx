@@ -4,6 +4,7 @@
     #include "nlohmann/json.hpp"
 
     #include <chrono>
+    #include <algorithm>
 
     namespace SJM
     {
@@ -14,7 +15,7 @@
         struct JobStruct
         {
             std::string exitCodeStatus,node,partition,currentState,stateReason,name;
-            long unsigned jobId,taskId,elapsedTime,maxTime,startTime,endTime,submissionTime,priority,usedMemory,maxMemory;
+            long unsigned jobId,taskId,rawJobId,elapsedTime,maxTime,startTime,endTime,submissionTime,priority,usedMemory,maxMemory;
             std::vector<std::string> flags;
         };
         /**
@@ -25,6 +26,14 @@
         {
             std::string nTasks;
         };
+        /**
+         * @brief Helper struct for holding the information provided by squeue, which also describes pending array tasks by a range expression
+         * 
+         */
+        struct SqueueJobStruct : public JobStruct
+        {
+            std::string taskString;
+        };
         /**
          * @brief Override of nlohmann::json method for data serialisation
          * 
@@ -32,6 +41,13 @@
          * @param job output Job struct
          */
         void from_json(const nlohmann::json &j,JobStruct &job);
+        /**
+         * @brief Override of nlohmann::json method for data serialisation of squeue output
+         * 
+         * @param j input nlohmann::json object
+         * @param job output squeue Job struct
+         */
+        void from_json(const nlohmann::json &j,SqueueJobStruct &job);
         /**
          * @brief Override of nlohmann::json method for data serialisation
          * 
@@ -74,11 +90,21 @@
 
                 Job(const JobStruct &j);
                 [[nodiscard]] State GetState() const noexcept;
+                /**
+                 * @brief Check if the job is still known to the scheduler, i.e. it has not reached a final state
+                 * 
+                 * @return true if the job is pending, running, requeued, resizing or suspended
+                 */
+                [[nodiscard]] bool IsActive() const noexcept;
                 [[nodiscard]] Partition GetPartition() const noexcept;
                 [[nodiscard]] std::string GetNode() const noexcept;
+                [[nodiscard]] std::string GetStateName() const;
+                [[nodiscard]] std::string GetStateReason() const noexcept;
+                [[nodiscard]] std::string GetExitCodeStatus() const noexcept;
                 [[nodiscard]] std::string GetName() const noexcept;
                 [[nodiscard]] unsigned long GetJobId() const noexcept;
                 [[nodiscard]] unsigned long GetTaskId() const noexcept;
+                [[nodiscard]] unsigned long GetRawJobId() const noexcept;
                 [[nodiscard]] unsigned long GetUsedMem() const noexcept;
                 [[nodiscard]] unsigned long GetRequestedMem() const noexcept;
                 [[nodiscard]] std::chrono::seconds GetElapsedTime() const noexcept;
@@ -87,6 +113,17 @@
                 [[nodiscard]] std::chrono::system_clock::time_point GetEndTime() const noexcept;
                 [[nodiscard]] std::chrono::system_clock::time_point GetSubTime() const noexcept;
                 [[nodiscard]] std::vector<std::string> GetListOfFlags() const noexcept;
+                /**
+                 * @brief Check if the used memory was sampled from the running job, rather than taken from sacct or left unknown
+                 * 
+                 */
+                [[nodiscard]] bool HasSampledMem() const noexcept;
+                /**
+                 * @brief Override the used memory with a value sampled from a running job
+                 * 
+                 * @param mem used memory in bytes, zero is a valid sample
+                 */
+                void SetSampledMem(unsigned long mem) noexcept;
 
             private:
                 [[nodiscard]] std::chrono::seconds MakeDuration(unsigned long) const noexcept;
@@ -94,13 +131,14 @@
 
                 State m_currentState;
                 Partition m_partition;
-                const std::map<std::string,State> m_stateMap;
-                const std::map<std::string,Partition> m_partitionMap;
+                static const std::map<std::string,State> m_stateMap;
+                static const std::map<std::string,Partition> m_partitionMap;
                 std::string m_exitCodeStatus,m_node,m_stateReason,m_name;
-                long unsigned m_jobId,m_taskId,m_priority,m_usedMemory,m_maxMemory;
+                long unsigned m_jobId,m_taskId,m_rawJobId,m_priority,m_usedMemory,m_maxMemory;
                 std::chrono::seconds m_elapsedTime,m_maxTime;
                 std::chrono::system_clock::time_point m_startTime,m_endTime,m_submissionTime;
                 std::vector<std::string> m_flags;
+                bool m_hasSampledMem;
         };
 
         inline std::chrono::seconds Job::MakeDuration(unsigned long time) const noexcept {return std::chrono::seconds(time);}
@@ -111,11 +149,29 @@
         }
 
         inline Job::State Job::GetState() const noexcept {return m_currentState;}
+        inline bool Job::IsActive() const noexcept
+        {
+            switch (m_currentState)
+            {
+                case State::Requeued :
+                case State::Resizing :
+                case State::Pending :
+                case State::Running :
+                case State::Suspended :
+                    return true;
+
+                default:
+                    return false;
+            }
+        }
         inline Job::Partition Job::GetPartition() const noexcept {return m_partition;}
         inline std::string Job::GetNode() const noexcept {return m_node;}
+        inline std::string Job::GetStateReason() const noexcept {return m_stateReason;}
+        inline std::string Job::GetExitCodeStatus() const noexcept {return m_exitCodeStatus;}
         inline std::string Job::GetName() const noexcept {return m_name;}
         inline unsigned long Job::GetJobId() const noexcept {return m_jobId;}
         inline unsigned long Job::GetTaskId() const noexcept {return m_taskId;}
+        inline unsigned long Job::GetRawJobId() const noexcept {return m_rawJobId;}
         inline unsigned long Job::GetUsedMem() const noexcept {return m_usedMemory;}
         inline unsigned long Job::GetRequestedMem() const noexcept {return m_maxMemory;}
         inline std::chrono::seconds Job::GetElapsedTime() const noexcept {return m_elapsedTime;}
@@ -124,6 +180,12 @@
         inline std::chrono::system_clock::time_point Job::GetEndTime() const noexcept {return m_endTime;}
         inline std::chrono::system_clock::time_point Job::GetSubTime() const noexcept {return m_submissionTime;}
         inline std::vector<std::string> Job::GetListOfFlags() const noexcept {return m_flags;}
+        inline bool Job::HasSampledMem() const noexcept {return m_hasSampledMem;}
+        inline void Job::SetSampledMem(unsigned long mem) noexcept
+        {
+            m_usedMemory = mem;
+            m_hasSampledMem = true;
+        }
 
     } // namespace SJM
     
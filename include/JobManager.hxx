@@ -12,12 +12,22 @@
     #define JobManager_hxx
 
     #include "Graphics.hxx"
+    #include "MemorySampler.hxx"
 
     #include <cstdlib>
     #include <iostream>
     #include <fstream>
     #include <chrono>
     #include <utility>
+    #include <algorithm>
+    #include <future>
+    #include <thread>
+    #include <set>
+    #include <map>
+    #include <cstdio>
+    #include <optional>
+    #include <pwd.h>
+    #include <unistd.h>
 
     namespace SJM
     {
@@ -29,8 +39,9 @@
                  * 
                  * @param username name of the user for whom the jobs should be monitored
                  * @param jobIds collection of SLURM job ids to be monitored
+                 * @param sampleMemory if true, the memory usage of running jobs is sampled with sstat
                  */
-                JobManager(const std::string &username, const std::vector<unsigned long> &jobIds) noexcept;
+                JobManager(const std::string &username, const std::vector<unsigned long> &jobIds, bool sampleMemory) noexcept;
                 /**
                  * @brief Called to read information about all the specified jobs
                  * 
@@ -47,23 +58,89 @@
             private:
 
                 [[nodiscard]] std::string ParseVector(const std::vector<unsigned long> &vec) const noexcept;
-                std::string ExecuteCommand(const std::string &username,const std::vector<unsigned long> &jobIds);
+                [[nodiscard]] std::string ParseVector(const std::vector<std::pair<unsigned long,unsigned long> > &vec) const noexcept;
+                std::string ExecuteCommand(const std::string_view &program,const std::string &username,const std::string &jobList,const std::string_view &outputPath);
+                /**
+                 * @brief Build the current job view from squeue for the jobs still in the queue and from sacct for the ones which have left it since the last poll
+                 * 
+                 * @return std::tuple<std::vector<Job>,std::size_t> merged job collection and number of pending tasks
+                 */
+                [[nodiscard]] std::tuple<std::vector<Job>,std::size_t> FetchJobs();
+                /**
+                 * @brief Keep the sacct records of jobs which are no longer in the queue. Records which sacct does not consider final yet are added to the unsettled jobs, so they are queried again on the next poll
+                 * 
+                 * @param jobVec jobs read from sacct
+                 * @param unsettledJobs jobs currently reported by squeue and jobs still waiting for their final sacct record, by (job id, task id)
+                 */
+                void StoreAccountedJobs(std::vector<Job> &&jobVec, std::map<std::pair<unsigned long,unsigned long>,Job> &unsettledJobs);
+                /**
+                 * @brief Read the squeue output. Tasks which squeue still lists after they have ended are only returned by their keys, so that their final record can be taken from sacct
+                 * 
+                 * @param j squeue output
+                 * @return std::tuple<std::vector<Job>,std::size_t,std::vector<std::pair<unsigned long,unsigned long> >,std::map<unsigned long,std::size_t> > active jobs, number of pending tasks,
+                 * (job id, task id) pairs of ended tasks and number of queued (pending or active) tasks for each array job id
+                 */
+                [[nodiscard]] std::tuple<std::vector<Job>,std::size_t,std::vector<std::pair<unsigned long,unsigned long> >,std::map<unsigned long,std::size_t> > FromSqueueJsonToJobVector(const nlohmann::json &j) const;
                 [[nodiscard]] nlohmann::json ReadJson(const std::string_view &strView);
                 [[nodiscard]] std::tuple<std::vector<Job>,std::size_t> FromJsonToJobVector(const nlohmann::json &j);
+                /**
+                 * @brief Decode the [first,last) range of the sacct jobs array. Safe to call concurrently on disjoint ranges
+                 * 
+                 * @param jobs the "jobs" array from the sacct output
+                 * @param first index of the first entry to decode
+                 * @param last index one past the last entry to decode
+                 * @return std::tuple<std::vector<Job>,std::size_t> decoded jobs and number of pending tasks in the range
+                 */
+                [[nodiscard]] std::tuple<std::vector<Job>,std::size_t> DecodeJobChunk(const nlohmann::json &jobs, std::size_t first, std::size_t last) const;
+                /**
+                 * @brief Check if the record belongs to the monitored user and job ids. The filters passed to squeue and sacct are not honoured with --json by every SLURM release
+                 * 
+                 * @param job decoded record
+                 * @return true if the record should be monitored
+                 */
+                [[nodiscard]] bool IsMonitored(const JobStruct &job) const;
                 [[nodiscard]] unsigned ConvertBatchHash(const std::string &str) const;
+                /**
+                 * @brief Count the tasks in a squeue array task expression, e.g. "1-9:2,12,20-30%4"
+                 * 
+                 * @param str array task expression
+                 * @return unsigned number of tasks
+                 */
+                [[nodiscard]] unsigned CountArrayTasks(const std::string &str) const;
+                /**
+                 * @brief Replace the used memory of running jobs with the MaxRSS sampled by the memory sampler, and count the sampled jobs and unparsed sstat lines
+                 * 
+                 */
+                void ApplyMemorySamples();
                 [[nodiscard]] std::size_t CountJobsByState(const std::vector<Job> &vec, Job::State state) const;
                 std::tuple<std::chrono::seconds,long unsigned,long unsigned> PopulateVariables(const std::vector<Job> &jobVec);
                 [[nodiscard]] std::string PrintTime(std::chrono::seconds time) const;
                 [[nodiscard]] std::string PrintTime(std::chrono::system_clock::time_point time) const;
 
                 static constexpr std::string_view m_pathToJson{"./sacct.json"};
+                static constexpr std::string_view m_pathToSqueueJson{"./squeue.json"};
+                static constexpr std::size_t m_samplingBudget = 512; // maximal number of running tasks queried by sstat in one poll
+                static constexpr std::size_t m_samplingBatchSize = 64;
+                static constexpr std::size_t m_samplingConcurrency = 4;
+                static constexpr std::size_t m_maxHotNodes = 5;
+                static constexpr unsigned m_fullRefreshInterval = 15; // every n-th poll queries sacct for all jobs, to pick up ones which came and went between polls
                 static constexpr double m_toGiga = 1./1024/1024/1024;
+                static constexpr std::size_t m_minChunkSize = 2048; // smallest number of sacct entries worth handing to a separate thread
 
                 std::size_t m_totalJobs;
                 std::string m_resetPos;
                 std::string m_userName;
                 const std::vector<unsigned long> m_jobIdsVector;
                 std::vector<Job> m_jobCollection;
+                std::map<std::pair<unsigned long,unsigned long>,Job> m_accountedJobs;
+                std::map<std::pair<unsigned long,unsigned long>,Job> m_unsettledJobs;
+                std::set<std::pair<unsigned long,unsigned long> > m_queuedTasks; // tasks listed as active by squeue on the last poll
+                std::map<unsigned long,std::size_t> m_queuedPerArray; // number of pending and active tasks of each array on the last poll
+                unsigned m_pollsSinceFullRefresh;
+                bool m_useSqueue;
+                unsigned m_pollsWithoutSqueue;
+                std::set<std::pair<unsigned long,unsigned long> > m_changedJobs; // jobs whose record was refreshed by the last FetchJobs call
+                bool m_isFullyReloaded; // true if the last FetchJobs call reloaded every job from sacct
                 std::chrono::seconds m_averageRunTime, m_remainingTime;
                 std::chrono::system_clock::time_point m_eta;
                 std::size_t m_numberOfJobs, m_finishedCounter, m_runningCounter, m_pendingCounter, m_failedCounter, m_requeueCounter, m_resizeCounter, m_suspendedCounter;
@@ -71,6 +148,9 @@
                 double m_averagePastMemUsed;
                 bool m_hasJobsWithFinishedState;
                 Graphics m_gui;
+                JobRollup m_rollup;
+                std::optional<MemorySampler> m_memorySampler;
+                std::size_t m_sampledCounter, m_unparsedSamples; // running jobs with a sampled MaxRSS and sstat lines which could not be matched to any of them
                 const std::map<char,unsigned> m_hexTrueCounter;
 
         };
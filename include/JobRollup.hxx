@@ -0,0 +1,152 @@
+/**
+ * @file JobRollup.hxx
+ * @author Jędrzej Kołaś (jedrzej.kolas.dokt@pw.edu.pl)
+ * @brief Per-node and per-partition statistics of the monitored jobs, updated only for the jobs which have changed since the previous poll
+ * @version 2.0.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef JobRollup_hxx
+    #define JobRollup_hxx
+
+    #include "Job.hxx"
+
+    #include <array>
+    #include <map>
+    #include <set>
+    #include <cmath>
+    #include <vector>
+    #include <utility>
+    #include <algorithm>
+
+    namespace SJM
+    {
+        /**
+         * @brief Helper struct for holding the aggregated statistics of a group of jobs (e.g. all jobs on one node)
+         *
+         */
+        struct GroupStats
+        {
+            static constexpr std::size_t nStates = static_cast<std::size_t>(Job::State::BootFail) + 1;
+
+            std::array<std::size_t,nStates> stateCounts{};
+            std::map<std::string,std::size_t> failureReasons;
+            std::size_t nCompleted = 0, nFailed = 0, nWithRunTime = 0, nWithMemory = 0;
+            std::chrono::seconds sumRunTime{0};
+            double sumUsedMem = 0; // in bytes
+
+            [[nodiscard]] std::size_t GetCount(Job::State state) const noexcept {return stateCounts.at(static_cast<std::size_t>(state));}
+            [[nodiscard]] std::size_t GetSettledCount() const noexcept {return nCompleted + nFailed;}
+            [[nodiscard]] bool IsEmpty() const noexcept {return std::all_of(stateCounts.begin(),stateCounts.end(),[](std::size_t count){return count == 0;});}
+            [[nodiscard]] std::chrono::seconds GetMeanRunTime() const noexcept {return (nWithRunTime > 0) ? sumRunTime / static_cast<std::chrono::seconds::rep>(nWithRunTime) : std::chrono::seconds(0);}
+            [[nodiscard]] double GetMeanUsedMem() const noexcept {return (nWithMemory > 0) ? sumUsedMem / nWithMemory : 0.;}
+            [[nodiscard]] double GetFailureRate() const noexcept {return (nCompleted + nFailed > 0) ? static_cast<double>(nFailed) / static_cast<double>(nCompleted + nFailed) : 0.;}
+        };
+        /**
+         * @brief Helper struct for holding information about a node with an anomalous failure rate
+         *
+         */
+        struct HotNode
+        {
+            std::string node, topReason;
+            std::size_t nFailed, nSettled;
+            double failureRate;
+        };
+
+        class JobRollup
+        {
+            public:
+                /**
+                 * @brief Construct a new Job Rollup object
+                 *
+                 */
+                JobRollup() noexcept;
+                /**
+                 * @brief Bring the statistics up to date for the jobs which have changed since the last update. Keys missing from the collection are dropped from the statistics
+                 *
+                 * @param jobVec collection of jobs obtained by JobManager, sorted by (job id, task id)
+                 * @param changedKeys (job id, task id) pairs of the jobs which may have changed
+                 */
+                void Update(const std::vector<Job> &jobVec, const std::set<std::pair<unsigned long,unsigned long> > &changedKeys);
+                /**
+                 * @brief Recompute the statistics from scratch, for when the whole job collection has been reloaded
+                 *
+                 * @param jobVec collection of jobs obtained by JobManager
+                 */
+                void Rebuild(const std::vector<Job> &jobVec);
+                /**
+                 * @brief Find nodes whose failure rate is significantly higher than the failure rate of all jobs. A node is flagged when its number of failures would be unlikely
+                 * (after correcting for the number of nodes with at least one completed or failed job) had it failed as often as the rest
+                 *
+                 * @param maxNodes maximal number of nodes to return
+                 * @return std::vector<HotNode> nodes sorted by failure rate, highest first
+                 */
+                [[nodiscard]] std::vector<HotNode> GetHotNodes(std::size_t maxNodes) const;
+                [[nodiscard]] const std::map<std::string,GroupStats>& GetNodeStats() const noexcept;
+                [[nodiscard]] const std::map<Job::Partition,GroupStats>& GetPartitionStats() const noexcept;
+                [[nodiscard]] const GroupStats& GetTotalStats() const noexcept;
+
+            private:
+                /**
+                 * @brief The part of a job which is aggregated. Runtime of active jobs is left out, so that a job which is merely running longer does not count as changed
+                 *
+                 */
+                struct Contribution
+                {
+                    Job::State state;
+                    Job::Partition partition;
+                    bool failed;
+                    std::string node, reason;
+                    std::chrono::seconds runTime;
+                    unsigned long usedMemory;
+
+                    bool operator==(const Contribution &other) const = default;
+                };
+
+                void Upsert(const std::pair<unsigned long,unsigned long> &key, const Job &job);
+                void Remove(const std::pair<unsigned long,unsigned long> &key);
+                [[nodiscard]] Contribution MakeContribution(const Job &job) const;
+                /**
+                 * @brief Describe why the job has failed, using its final state, exit status and (if set) state reason, e.g. "OUT_OF_MEMORY" or "FAILED/ERROR"
+                 * 
+                 */
+                [[nodiscard]] std::string MakeFailureReason(const Job &job) const;
+                /**
+                 * @brief Add (sign > 0) or subtract the contribution from its groups. Groups left without any job are erased, so nodes which are not used anymore do not linger
+                 * 
+                 */
+                void Apply(const Contribution &contribution, int sign);
+                void ApplyToGroup(GroupStats &group, const Contribution &contribution, int sign) const;
+                [[nodiscard]] bool HasNode(const Contribution &contribution) const noexcept;
+                /**
+                 * @brief Check if the state is a failure which may be caused by the node, as opposed to the user or the scheduler stopping the job. Only those count as failures in the statistics, the rest is still visible in the state counts
+                 * 
+                 */
+                [[nodiscard]] bool IsNodeFailure(Job::State state) const noexcept;
+                /**
+                 * @brief Probability of at least k failures out of n jobs, if each fails with probability p
+                 * 
+                 */
+                [[nodiscard]] double BinomialTail(std::size_t k, std::size_t n, double p) const noexcept;
+
+                static constexpr std::size_t m_minFailures = 3; // a node needs at least this many failed jobs to be considered hot
+                static constexpr double m_falseAlarmRate = 0.01; // chance of flagging any node while all of them fail equally often
+
+                std::map<std::pair<unsigned long,unsigned long>,Contribution> m_contributions;
+                std::map<std::string,GroupStats> m_nodeStats;
+                std::map<Job::Partition,GroupStats> m_partitionStats;
+                GroupStats m_totalStats;
+                std::set<std::string> m_candidateNodes;
+                std::size_t m_settledNodes; // nodes with at least one completed or failed job, i.e. the nodes which are actually tested
+        };
+
+        inline const std::map<std::string,GroupStats>& JobRollup::GetNodeStats() const noexcept {return m_nodeStats;}
+        inline const std::map<Job::Partition,GroupStats>& JobRollup::GetPartitionStats() const noexcept {return m_partitionStats;}
+        inline const GroupStats& JobRollup::GetTotalStats() const noexcept {return m_totalStats;}
+
+    } // namespace SJM
+
+
+#endif
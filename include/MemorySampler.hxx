@@ -0,0 +1,72 @@
+/**
+ * @file MemorySampler.hxx
+ * @author Jędrzej Kołaś (jedrzej.kolas.dokt@pw.edu.pl)
+ * @brief Class for sampling the memory usage of running jobs using sstat
+ * @version 2.0.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef MemorySampler_hxx
+    #define MemorySampler_hxx
+
+    #include "Job.hxx"
+
+    #include <cstdio>
+    #include <array>
+    #include <map>
+    #include <vector>
+    #include <future>
+    #include <tuple>
+    #include <utility>
+    #include <algorithm>
+
+    namespace SJM
+    {
+        class MemorySampler
+        {
+            public:
+                /**
+                 * @brief Construct a new Memory Sampler object
+                 *
+                 * @param budget maximal number of tasks sampled in one cycle
+                 * @param batchSize number of tasks queried by a single sstat call
+                 * @param maxConcurrent maximal number of sstat calls running at the same time
+                 */
+                MemorySampler(std::size_t budget, std::size_t batchSize, std::size_t maxConcurrent) noexcept;
+                /**
+                 * @brief Sample the MaxRSS of up to budget running tasks. Each cycle continues where the previous one stopped, so large arrays are covered in turns
+                 *
+                 * @param jobVec collection of jobs obtained by JobManager
+                 * @return const std::map<std::pair<unsigned long,unsigned long>,unsigned long>& latest MaxRSS (in bytes) of each sampled running task, by (job id, task id)
+                 */
+                const std::map<std::pair<unsigned long,unsigned long>,unsigned long>& Sample(const std::vector<Job> &jobVec);
+                /**
+                 * @brief Number of sstat output lines in the last cycle which could not be matched to any sampled task
+                 * 
+                 */
+                [[nodiscard]] std::size_t GetUnparsedLines() const noexcept;
+
+            private:
+                /**
+                 * @brief Run a single sstat call for the batch. Steps are reported either as "jobid_taskid.step" or with the raw job id of the task, e.g. "1240.batch"
+                 * 
+                 * @param batch (job id, task id) pairs of the tasks to sample
+                 * @param rawJobIds (job id, task id) pairs of the running tasks by their raw job id
+                 * @return std::tuple<std::map<std::pair<unsigned long,unsigned long>,unsigned long>,std::size_t> MaxRSS (in bytes) of each task and number of lines which could not be parsed
+                 */
+                [[nodiscard]] std::tuple<std::map<std::pair<unsigned long,unsigned long>,unsigned long>,std::size_t> ExecuteBatch(const std::vector<std::pair<unsigned long,unsigned long> > &batch, 
+                    const std::map<unsigned long,std::pair<unsigned long,unsigned long> > &rawJobIds) const;
+                [[nodiscard]] unsigned long ParseMemory(const std::string &str) const;
+
+                std::size_t m_budget, m_batchSize, m_maxConcurrent, m_unparsedLines;
+                std::pair<unsigned long,unsigned long> m_lastSampled;
+                std::map<std::pair<unsigned long,unsigned long>,unsigned long> m_samples;
+        };
+
+        inline std::size_t MemorySampler::GetUnparsedLines() const noexcept {return m_unparsedLines;}
+    } // namespace SJM
+
+
+#endif
@@ -42,6 +42,10 @@ int main(int argc, char *argv[])
 
     parser.add_argument("--user","-u").help("username for whom the jobs should be displayed. Default is the callee");
     parser.add_argument("--jobs","-j").help("list of jobs you want to be monitored. Default is all jobs started since 00:00:00 of the current day").nargs(1,10).scan<'i',unsigned long>();
+    parser.add_argument("--memory","-m")
+        .default_value(false)
+        .implicit_value(true)
+        .help("sample the memory usage of running jobs with sstat instead of extrapolating it from the finished ones");
     auto &group = parser.add_mutually_exclusive_group();
     group.add_argument("-f","--fast")
         .action([&](const auto &){multiplier /= 2.;})
@@ -74,7 +78,8 @@ int main(int argc, char *argv[])
 
     SJM::JobManager jm(
         parser.is_used("--user") ? parser.get<std::string>("--user") : "", 
-        parser.is_used("--jobs") ? parser.get<std::vector<unsigned long> >("--jobs") : std::vector<unsigned long>()
+        parser.is_used("--jobs") ? parser.get<std::vector<unsigned long> >("--jobs") : std::vector<unsigned long>(),
+        parser.get<bool>("--memory")
         );
 
     multiplier = std::min(multiplier,maxMult); // see if we exceeded the predefined bounds
@@ -7,11 +7,13 @@ namespace SJM
         ftxui::Elements contents;
 
         contents.push_back(ftxui::hbox(
-            RenderMemUsage(info.usedMem,info.reqMem),
+            RenderMemUsage(info.usedMem,info.reqMem,info.sampledJobs,info.unparsedSamples),
             RenderBatchInfo(info.finishedJobs,info.runningJobs,info.nJobs,info.name,info.remainigTime,info.ETA,info.avgPastRuntime) | ftxui::flex
         ));
         contents.push_back(RenderProgressBar(info.finishedJobs,info.nJobs));
         contents.push_back(RenderStatusBlock(jobVec,info.nJobs));
+        if (!info.hotNodes.empty())
+            contents.push_back(RenderHotNodes(info.hotNodes));
 
         return ftxui::vbox(std::move(contents));
     }
@@ -142,10 +144,16 @@ namespace SJM
         ) | ftxui::border;
     }
 
-    ftxui::Element Graphics::RenderMemUsage(unsigned avgUsed, unsigned requested) const
+    ftxui::Element Graphics::RenderMemUsage(unsigned avgUsed, unsigned requested, std::size_t sampled, std::size_t unparsed) const
     {
         float prct = static_cast<float>(avgUsed) / static_cast<float>(requested);
 
+        ftxui::Elements samplingInfo;
+        if (sampled > 0)
+            samplingInfo.push_back(ftxui::text("Sampled: " + std::to_string(sampled) + " jobs") | ftxui::center);
+        if (unparsed > 0) // sstat answered in a format which is not understood, so the estimate relies on fewer samples than it could
+            samplingInfo.push_back(ftxui::text("Unparsed sstat: " + std::to_string(unparsed)) | ftxui::center | ftxui::color(ftxui::Color::Red));
+
         return ftxui::vbox(
                 ftxui::text("Current Memory Usage") | ftxui::center,
                 ftxui::hbox(
@@ -182,7 +190,8 @@ namespace SJM
                     )
                 ),
                 ftxui::separator(),
-                ftxui::text("Requested: " + std::to_string(requested) + " MB") | ftxui::center
+                ftxui::text("Requested: " + std::to_string(requested) + " MB") | ftxui::center,
+                ftxui::vbox(std::move(samplingInfo))
             ) | ftxui::border;
     }
 
@@ -209,6 +218,26 @@ namespace SJM
         ) | ftxui::border;
     }
 
+    ftxui::Element Graphics::RenderHotNodes(const std::vector<HotNode> &hotNodes) const
+    {
+        ftxui::Elements list;
+        for (const HotNode &node : hotNodes)
+        {
+            list.push_back(ftxui::hbox(
+                ftxui::text(node.node) | ftxui::color(ftxui::Color::Red),
+                ftxui::filler(),
+                ftxui::text(std::to_string(node.nFailed) + "/" + std::to_string(node.nSettled) + " failed (" + std::to_string(static_cast<int>(node.failureRate * 100)) + "%)"),
+                ftxui::text((node.topReason.empty()) ? "" : ", mostly " + node.topReason)
+            ));
+        }
+
+        return ftxui::vbox(
+            ftxui::text("Nodes with unusually many failures") | ftxui::center,
+            ftxui::separator(),
+            ftxui::vbox(std::move(list))
+        ) | ftxui::border;
+    }
+
     std::pair<std::string,ftxui::Color> Graphics::GetColorByStatus(const Job::State state) const
     {
         switch (state)
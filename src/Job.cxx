@@ -14,6 +14,7 @@ namespace SJM
         job.exitCodeStatus = j["exit_code"]["status"].get<std::vector<std::string> >().at(0);
         job.flags = j["flags"].get<std::vector<std::string> >();
         job.jobId = j["array"]["job_id"].get<long unsigned>();
+        job.rawJobId = j["job_id"].get<long unsigned>();
         job.maxMemory = j["required"]["memory_per_node"]["number"].get<long unsigned>();
         job.node = j["nodes"].get<std::string>();
         job.partition = j["partition"].get<std::string>();
@@ -26,14 +27,42 @@ namespace SJM
             job.usedMemory = 0;
     }
 
+    void from_json(const nlohmann::json &j,SqueueJobStruct &job)
+    {
+        job.currentState = j["job_state"].get<std::vector<std::string> >().at(0);
+        job.endTime = j["end_time"]["number"].get<long unsigned>();
+        job.startTime = j["start_time"]["number"].get<long unsigned>();
+        job.maxTime = j["eligible_time"]["number"].get<long unsigned>();
+        job.submissionTime = j["submit_time"]["number"].get<long unsigned>();
+        job.name = j["user_name"].get<std::string>();
+        job.exitCodeStatus = j["exit_code"]["status"].get<std::vector<std::string> >().at(0);
+        job.flags = j["flags"].get<std::vector<std::string> >();
+        job.jobId = j["array_job_id"]["number"].get<long unsigned>();
+        job.rawJobId = j["job_id"].get<long unsigned>();
+        job.maxMemory = j["memory_per_node"]["number"].get<long unsigned>();
+        job.node = j["nodes"].get<std::string>();
+        job.partition = j["partition"].get<std::string>();
+        job.priority = j["priority"]["number"].get<long unsigned>();
+        job.stateReason = j["state_reason"].get<std::string>();
+        job.taskId = j["array_task_id"]["number"].get<long unsigned>();
+        job.taskString = j["array_task_string"].get<std::string>();
+        job.usedMemory = 0; // squeue does not report memory usage, it is only known once the job reaches sacct
+
+        // squeue has no elapsed time field. For running jobs the end time is only the time limit, so it is counted up to now,
+        // while jobs which have already ended (squeue keeps them for a while after completion) stop at their end time
+        const long unsigned now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const long unsigned stopTime = (job.endTime > 0 && job.endTime <= now) ? job.endTime : now;
+        job.elapsedTime = (job.currentState != "PENDING" && job.startTime > 0 && job.startTime < stopTime) ? stopTime - job.startTime : 0;
+    }
+
     void from_json(const nlohmann::json &j, JobArrayStruct &job)
     {
         job.nTasks = j["array"]["task"].get<std::string>();
     }
 
-    Job::Job(const JobStruct &j) : 
-    m_stateMap(
-        {{"REQUEUED",State::Requeued},
+    const std::map<std::string,Job::State> Job::m_stateMap
+    {
+        {"REQUEUED",State::Requeued},
         {"RESIZING",State::Resizing},
         {"PENDING",State::Pending},
         {"RUNNING",State::Running},
@@ -47,17 +76,21 @@ namespace SJM
         {"TIMEOUT",State::Timeout},
         {"DEADLINE",State::Deadline},
         {"CANCELLED",State::Cancelled},
-        {"BOOT_FAIL",State::BootFail}}
-    ),
-    m_partitionMap(
-        {{"main",Partition::Main},
+        {"BOOT_FAIL",State::BootFail}
+    };
+
+    const std::map<std::string,Job::Partition> Job::m_partitionMap
+    {
+        {"main",Partition::Main},
         {"long",Partition::Long},
         {"grid",Partition::Grid},
         {"high_mem",Partition::HighMem},
         {"gpu",Partition::Gpu},
         {"debug",Partition::Debug},
-        {"new",Partition::New}}
-    )
+        {"new",Partition::New}
+    };
+
+    Job::Job(const JobStruct &j)
     {
         m_currentState = m_stateMap.at(j.currentState);
         m_partition = m_partitionMap.at(j.partition);
@@ -66,6 +99,7 @@ namespace SJM
         m_stateReason = j.stateReason;
         m_jobId = j.jobId;
         m_taskId = j.taskId;
+        m_rawJobId = j.rawJobId;
         m_priority = j.priority;
         m_usedMemory = j.usedMemory;
         m_maxMemory = j.maxMemory;
@@ -75,6 +109,13 @@ namespace SJM
         m_endTime = MakeTimePoint(j.endTime);
         m_submissionTime = MakeTimePoint(j.submissionTime);
         m_flags = j.flags;
+        m_hasSampledMem = false;
+    }
+
+    std::string Job::GetStateName() const
+    {
+        auto it = std::find_if(m_stateMap.begin(),m_stateMap.end(),[this](const auto &entry){return entry.second == m_currentState;});
+        return (it != m_stateMap.end()) ? it->first : "";
     }
 
 } // namespace SJM
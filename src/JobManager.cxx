@@ -2,11 +2,14 @@
 
 namespace SJM
 {
-    JobManager::JobManager(const std::string &username,const std::vector<unsigned long> &jobIds) noexcept : 
-    m_totalJobs(0), m_userName(username), m_jobIdsVector(jobIds), m_jobCollection({}), m_averageRunTime(std::chrono::seconds(0)),
+    JobManager::JobManager(const std::string &username,const std::vector<unsigned long> &jobIds,bool sampleMemory) noexcept : 
+    m_totalJobs(0), m_userName(username), m_jobIdsVector(jobIds), m_jobCollection({}), m_accountedJobs({}),
+    m_unsettledJobs({}), m_queuedTasks({}), m_queuedPerArray({}), m_pollsSinceFullRefresh(m_fullRefreshInterval), m_useSqueue(true), m_pollsWithoutSqueue(0), m_changedJobs({}), m_isFullyReloaded(true), m_averageRunTime(std::chrono::seconds(0)),
     m_remainingTime(std::chrono::seconds(0)), m_eta(std::chrono::system_clock::now()), m_numberOfJobs(0), m_finishedCounter(0), m_runningCounter(0), 
     m_pendingCounter(0), m_failedCounter(0), m_requeueCounter(0), m_resizeCounter(0), m_suspendedCounter(0),
-    m_totalMemAssigned(0.), m_predictedTotalMemUsed(0.), m_averagePastMemUsed(0.), m_hasJobsWithFinishedState(false), m_gui(),
+    m_totalMemAssigned(0.), m_predictedTotalMemUsed(0.), m_averagePastMemUsed(0.), m_hasJobsWithFinishedState(false), m_gui(), m_rollup(),
+    m_memorySampler(sampleMemory ? std::make_optional<MemorySampler>(m_samplingBudget,m_samplingBatchSize,m_samplingConcurrency) : std::nullopt),
+    m_sampledCounter(0), m_unparsedSamples(0),
     m_hexTrueCounter(
         {{'0',0},
         {'1',1},
@@ -26,12 +29,22 @@ namespace SJM
         {'F',4}}
     )
     {
+        if (m_userName == "") // squeue output is filtered by the user name, so the callee is resolved up front. If that fails, "--me" is still passed to squeue
+        {
+            const passwd *pw = getpwuid(geteuid());
+            if (pw != nullptr)
+                m_userName = pw->pw_name;
+        }
     }
 
     bool JobManager::UpdateJobs()
     {
-        ExecuteCommand(m_userName,m_jobIdsVector);
-        std::tie(m_jobCollection,m_pendingCounter) = FromJsonToJobVector(ReadJson(m_pathToJson));
+        std::tie(m_jobCollection,m_pendingCounter) = FetchJobs();
+        ApplyMemorySamples();
+        if (m_isFullyReloaded)
+            m_rollup.Rebuild(m_jobCollection);
+        else
+            m_rollup.Update(m_jobCollection,m_changedJobs);
         std::tie(m_averageRunTime,m_totalMemAssigned,m_predictedTotalMemUsed) = PopulateVariables(m_jobCollection);
 
         /* std::cout << m_totalJobs << "\n";
@@ -58,7 +71,10 @@ namespace SJM
                 m_runningCounter,
                 m_predictedTotalMemUsed,
                 m_totalMemAssigned,
-                m_hasJobsWithFinishedState
+                m_hasJobsWithFinishedState,
+                m_sampledCounter,
+                m_unparsedSamples,
+                m_rollup.GetHotNodes(m_maxHotNodes)
             }
         );
         auto screen = ftxui::Screen::Create(ftxui::Dimension::Full(),ftxui::Dimension::Fit(document));
@@ -70,24 +86,218 @@ namespace SJM
 
     std::string JobManager::ParseVector(const std::vector<unsigned long> &vec) const noexcept
     {
-        std::string outputCommand = " ";
+        std::string outputCommand = "";
         for (const auto &elem : vec)
             outputCommand += std::to_string(elem) + ",";
 
         return outputCommand;
     }
 
-    std::string JobManager::ExecuteCommand(const std::string &username,const std::vector<unsigned long> &jobIds)
+    std::string JobManager::ParseVector(const std::vector<std::pair<unsigned long,unsigned long> > &vec) const noexcept
+    {
+        std::string outputCommand = "";
+        for (const auto &[jobId,taskId] : vec)
+            outputCommand += std::to_string(jobId) + "_" + std::to_string(taskId) + ",";
+
+        return outputCommand;
+    }
+
+    std::string JobManager::ExecuteCommand(const std::string_view &program,const std::string &username,const std::string &jobList,const std::string_view &outputPath)
     {
-        std::string userFlag = (username != "") ? "-u " + username + " " : "";
-        std::string jobidFlag = (jobIds.size() > 0) ? "-j " + ParseVector(jobIds) : ""; // Comment from "man sacct": -S: Select jobs eligible after this time. Default is 00:00:00 of the current day
+        std::string userFlag = (username != "") ? "-u " + username + " " : (program == "squeue") ? "--me " : ""; // unlike sacct, squeue lists the jobs of every user by default
+        std::string jobidFlag = (jobList.size() > 0) ? "-j " + jobList : ""; // Comment from "man sacct": -S: Select jobs eligible after this time. Default is 00:00:00 of the current day
 
-        std::string command = "sacct " + userFlag + jobidFlag + " --json > sacct.json";
+        std::string errorRedirect = (program == "squeue") ? " 2> /dev/null" : ""; // a failing squeue is handled by falling back to sacct, its complaints would only garble the TUI
+
+        std::string command = std::string(program) + " " + userFlag + jobidFlag + " --json > " + std::string(outputPath) + errorRedirect;
         std::system(command.data());
 
         return command;
     }
 
+    std::tuple<std::vector<Job>,std::size_t> JobManager::FetchJobs()
+    {
+        // squeue is answered by slurmctld from memory, while sacct has to go through the accounting database, so the latter is asked only when needed
+        m_changedJobs.clear();
+        m_isFullyReloaded = true;
+
+        if (!m_useSqueue && ++m_pollsWithoutSqueue >= m_fullRefreshInterval) // the failure may have been just a slurmctld timeout, so squeue gets another chance once in a while
+            m_useSqueue = true;
+
+        nlohmann::json squeueJson;
+        if (m_useSqueue)
+        {
+            ExecuteCommand("squeue",m_userName,ParseVector(m_jobIdsVector),m_pathToSqueueJson);
+            std::ifstream f(m_pathToSqueueJson.data());
+            squeueJson = nlohmann::json::parse(f,nullptr,false); // missing or empty output is not an error worth printing over the TUI
+
+            // squeue is not available, timed out or rejected the job ids (happens when all of them have left the queue), so it is skipped for the next polls
+            if (!squeueJson.contains("jobs"))
+            {
+                m_useSqueue = false;
+                m_pollsWithoutSqueue = 0;
+            }
+        }
+        if (!m_useSqueue)
+        {
+            m_accountedJobs.clear();
+            m_unsettledJobs.clear();
+            m_queuedTasks.clear();
+            m_queuedPerArray.clear();
+            m_pollsSinceFullRefresh = m_fullRefreshInterval;
+            ExecuteCommand("sacct",m_userName,ParseVector(m_jobIdsVector),m_pathToJson);
+            return FromJsonToJobVector(ReadJson(m_pathToJson));
+        }
+
+        auto [activeJobs,njobs,finishedTasks,queuedPerArray] = FromSqueueJsonToJobVector(squeueJson);
+        std::set<std::pair<unsigned long,unsigned long> > activeKeys;
+        std::map<std::pair<unsigned long,unsigned long>,Job> unsettledJobs;
+        for (const Job &job : activeJobs)
+        {
+            activeKeys.emplace(job.GetJobId(),job.GetTaskId());
+            m_changedJobs.emplace(job.GetJobId(),job.GetTaskId());
+            unsettledJobs.insert_or_assign(std::make_pair(job.GetJobId(),job.GetTaskId()),job);
+        }
+
+        if (m_pollsSinceFullRefresh >= m_fullRefreshInterval)
+        {
+            m_pollsSinceFullRefresh = 0;
+            m_accountedJobs.clear();
+            ExecuteCommand("sacct",m_userName,ParseVector(m_jobIdsVector),m_pathToJson);
+            StoreAccountedJobs(std::get<0>(FromJsonToJobVector(ReadJson(m_pathToJson))),unsettledJobs);
+        }
+        else
+        {
+            ++m_pollsSinceFullRefresh;
+            m_isFullyReloaded = false;
+
+            // tasks which were in the queue on the last poll and are not anymore have finished, so exactly those are looked up in sacct
+            std::set<std::pair<unsigned long,unsigned long> > departedTasks;
+            for (const auto &[key,job] : m_unsettledJobs)
+            {
+                if (unsettledJobs.contains(key))
+                    continue;
+
+                departedTasks.insert(key);
+                m_accountedJobs.insert_or_assign(key,job); // the last known record stays in the view until sacct has the final one
+            }
+            // squeue still lists tasks for a while after they end, but without their memory usage, so their final record is taken from sacct
+            for (const auto &key : finishedTasks)
+            {
+                auto accounted = m_accountedJobs.find(key);
+                if (accounted == m_accountedJobs.end() || accounted->second.IsActive())
+                    departedTasks.insert(key);
+            }
+
+            // tasks which went from pending straight to a final state between two polls are never seen leaving the queue, but their array then has fewer
+            // queued tasks than the seen departures explain, so the whole array is looked up
+            std::map<unsigned long,std::size_t> seenLeaving;
+            for (const auto &key : m_queuedTasks)
+            {
+                if (!activeKeys.contains(key))
+                    ++seenLeaving[key.first];
+            }
+            for (const auto &key : finishedTasks)
+            {
+                if (!m_queuedTasks.contains(key))
+                    ++seenLeaving[key.first];
+            }
+            std::vector<unsigned long> departedArrays;
+            for (const auto &[arrayId,nQueued] : m_queuedPerArray)
+            {
+                auto it = queuedPerArray.find(arrayId);
+                const std::size_t nQueuedNow = (it != queuedPerArray.end()) ? it->second : 0;
+                if (nQueued > nQueuedNow + seenLeaving[arrayId])
+                    departedArrays.push_back(arrayId);
+            }
+
+            if (!departedTasks.empty() || !departedArrays.empty())
+            {
+                m_changedJobs.insert(departedTasks.begin(),departedTasks.end());
+                ExecuteCommand("sacct",m_userName,ParseVector(std::vector<std::pair<unsigned long,unsigned long> >(departedTasks.begin(),departedTasks.end())) + ParseVector(departedArrays),m_pathToJson);
+                StoreAccountedJobs(std::get<0>(FromJsonToJobVector(ReadJson(m_pathToJson))),unsettledJobs);
+
+                for (const auto &key : departedTasks) // slurmdbd may not have the task at all yet, so it is asked about again on the next poll
+                {
+                    auto accounted = m_accountedJobs.find(key);
+                    if (accounted != m_accountedJobs.end() && accounted->second.IsActive())
+                        unsettledJobs.insert_or_assign(key,accounted->second);
+                }
+            }
+        }
+        m_unsettledJobs = std::move(unsettledJobs);
+        m_queuedTasks = activeKeys;
+        m_queuedPerArray = std::move(queuedPerArray);
+
+        std::vector<Job> jobVec = std::move(activeJobs);
+        jobVec.reserve(jobVec.size() + m_accountedJobs.size());
+        for (const auto &[key,job] : m_accountedJobs)
+        {
+            if (!activeKeys.contains(key)) // requeued jobs are back in the queue and squeue has the newer record
+                jobVec.push_back(job);
+        }
+        std::sort(jobVec.begin(),jobVec.end(),[](const Job &lhs, const Job &rhs)
+        {
+            return std::make_pair(lhs.GetJobId(),lhs.GetTaskId()) < std::make_pair(rhs.GetJobId(),rhs.GetTaskId());
+        });
+
+        return std::make_tuple(std::move(jobVec),njobs);
+    }
+
+    void JobManager::StoreAccountedJobs(std::vector<Job> &&jobVec, std::map<std::pair<unsigned long,unsigned long>,Job> &unsettledJobs)
+    {
+        for (Job &job : jobVec)
+        {
+            std::pair<unsigned long,unsigned long> key{job.GetJobId(),job.GetTaskId()};
+            if (unsettledJobs.contains(key)) // squeue has the newer record
+                continue;
+
+            if (job.IsActive()) // the job has left the queue but slurmdbd has not received its final state yet
+                unsettledJobs.insert_or_assign(key,job);
+
+            m_changedJobs.insert(key);
+
+            m_accountedJobs.insert_or_assign(key,std::move(job));
+        }
+    }
+
+    std::tuple<std::vector<Job>,std::size_t,std::vector<std::pair<unsigned long,unsigned long> >,std::map<unsigned long,std::size_t> > JobManager::FromSqueueJsonToJobVector(const nlohmann::json &j) const
+    {
+        std::vector<Job> jobVec;
+        std::vector<std::pair<unsigned long,unsigned long> > finishedTasks;
+        std::map<unsigned long,std::size_t> queuedPerArray;
+        std::size_t njobs = 0;
+        SqueueJobStruct jobStruct;
+        for (const auto &job : j["jobs"])
+        {
+            jobStruct = job.get<SqueueJobStruct>();
+            if (!IsMonitored(jobStruct))
+                continue;
+
+            if (jobStruct.taskId != 0)
+            {
+                Job squeueJob(jobStruct);
+                if (squeueJob.IsActive())
+                {
+                    jobVec.push_back(std::move(squeueJob));
+                    ++queuedPerArray[jobStruct.jobId];
+                }
+                else
+                {
+                    finishedTasks.emplace_back(jobStruct.jobId,jobStruct.taskId);
+                }
+            }
+            else
+            {
+                const std::size_t nTasks = CountArrayTasks(jobStruct.taskString);
+                njobs += nTasks;
+                queuedPerArray[jobStruct.jobId] += nTasks;
+            }
+        }
+
+        return std::make_tuple(std::move(jobVec),njobs,std::move(finishedTasks),std::move(queuedPerArray));
+    }
+
     nlohmann::json JobManager::ReadJson(const std::string_view &strView)
     {
         std::ifstream f(strView.data());
@@ -105,16 +315,49 @@ namespace SJM
     }
 
     std::tuple<std::vector<Job>,std::size_t> JobManager::FromJsonToJobVector(const nlohmann::json &j)
+    {
+        if (!j.contains("jobs"))
+            return std::make_tuple(std::vector<Job>{},0);
+
+        const nlohmann::json &jobs = j["jobs"];
+        const std::size_t nEntries = jobs.size();
+        const std::size_t nChunks = std::clamp<std::size_t>(nEntries / m_minChunkSize,1,std::max(1u,std::thread::hardware_concurrency()));
+        const std::size_t chunkSize = (nEntries + nChunks - 1) / nChunks;
+
+        // each chunk is decoded into its own buffer, so the workers never touch shared state
+        std::vector<std::future<std::tuple<std::vector<Job>,std::size_t> > > chunks;
+        for (std::size_t first = chunkSize; first < nEntries; first += chunkSize)
+            chunks.push_back(std::async(std::launch::async,&JobManager::DecodeJobChunk,this,std::cref(jobs),first,std::min(first + chunkSize,nEntries)));
+
+        // the first chunk is decoded on the calling thread, the rest are appended in task order to keep the output deterministic
+        auto [jobVec,njobs] = DecodeJobChunk(jobs,0,std::min(chunkSize,nEntries));
+        for (auto &chunk : chunks)
+        {
+            auto [chunkJobs,chunkPending] = chunk.get();
+            jobVec.insert(jobVec.end(),std::make_move_iterator(chunkJobs.begin()),std::make_move_iterator(chunkJobs.end()));
+            njobs += chunkPending;
+        }
+
+        return std::make_tuple(std::move(jobVec),njobs);
+    }
+
+    std::tuple<std::vector<Job>,std::size_t> JobManager::DecodeJobChunk(const nlohmann::json &jobs, std::size_t first, std::size_t last) const
     {
         std::vector<Job> jobVec;
         std::size_t njobs = 0;
         JobStruct jobStruct;
-        for (const auto &job : j["jobs"]) // I should check somewhere if I get any jobs at all
+
+        jobVec.reserve(last - first);
+        for (std::size_t i = first; i < last; ++i)
         {
+            const nlohmann::json &job = jobs[i];
             jobStruct = job.get<JobStruct>();
+            if (!IsMonitored(jobStruct))
+                continue;
+
             if (jobStruct.taskId != 0)
             {
-                jobVec.push_back(Job(jobStruct));
+                jobVec.emplace_back(jobStruct);
             }
             else
             {
@@ -122,7 +365,15 @@ namespace SJM
             }
         }
 
-        return std::make_tuple(jobVec,njobs);
+        return std::make_tuple(std::move(jobVec),njobs);
+    }
+
+    bool JobManager::IsMonitored(const JobStruct &job) const
+    {
+        if (m_userName != "" && job.name != m_userName)
+            return false;
+
+        return m_jobIdsVector.empty() || std::find_if(m_jobIdsVector.begin(),m_jobIdsVector.end(),[&job](unsigned long jobId){return jobId == job.jobId || jobId == job.rawJobId;}) != m_jobIdsVector.end();
     }
 
     unsigned JobManager::ConvertBatchHash(const std::string &str) const
@@ -134,6 +385,46 @@ namespace SJM
         return counter;
     }
 
+    unsigned JobManager::CountArrayTasks(const std::string &str) const
+    {
+        if (str.starts_with("0x")) // large arrays may be reported as a bitmap, same as in sacct
+            return ConvertBatchHash(str);
+
+        unsigned counter = 0;
+        std::stringstream ss(str.substr(0,str.find('%'))); // "%N" is the limit of simultaneously running tasks, not a part of the task list
+        std::string range;
+        while (std::getline(ss,range,','))
+        {
+            unsigned first = 0, last = 0, step = 1;
+            int nRead = std::sscanf(range.c_str(),"%u-%u:%u",&first,&last,&step);
+            if (nRead == 1)
+                ++counter;
+            else if (nRead > 1 && last >= first && step > 0)
+                counter += (last - first) / step + 1;
+        }
+
+        return counter;
+    }
+
+    void JobManager::ApplyMemorySamples()
+    {
+        if (!m_memorySampler.has_value())
+            return;
+
+        const auto &samples = m_memorySampler->Sample(m_jobCollection);
+        m_sampledCounter = 0;
+        for (Job &job : m_jobCollection)
+        {
+            auto it = samples.find(std::make_pair(job.GetJobId(),job.GetTaskId()));
+            if (it != samples.end() && job.GetState() == Job::State::Running)
+            {
+                job.SetSampledMem(it->second);
+                ++m_sampledCounter;
+            }
+        }
+        m_unparsedSamples = m_memorySampler->GetUnparsedLines();
+    }
+
     std::size_t JobManager::CountJobsByState(const std::vector<Job> &vec, Job::State state) const
     {
         return std::count_if(vec.begin(),vec.end(),[&state](const Job &j){return state == j.GetState();});
@@ -150,7 +441,8 @@ namespace SJM
         m_requeueCounter = 0;
         m_resizeCounter = 0;
         long unsigned sumReqMem = 0, predictedUsedMem = 0;
-        double sumUsedMem = 0, avgUsedMem = 0;
+        std::size_t sampledRunningCounter = 0;
+        double sumUsedMem = 0, avgUsedMem = 0, sumRunningMem = 0;
         std::chrono::seconds sumRunTime(0),avgRunTime(0);
         std::chrono::system_clock::time_point minStartTime(std::chrono::system_clock::now());
 
@@ -177,6 +469,11 @@ namespace SJM
                 case Job::State::Running :
                     ++m_runningCounter;
                     sumReqMem += job.GetRequestedMem()/1000;
+                    if (job.HasSampledMem())
+                    {
+                        ++sampledRunningCounter;
+                        sumRunningMem += job.GetUsedMem()*m_toGiga;
+                    }
                     break;
                     
                 case Job::State::Completed :
@@ -237,8 +534,13 @@ namespace SJM
         {
             avgUsedMem = sumUsedMem/m_finishedCounter;
             avgRunTime = sumRunTime/m_finishedCounter;
-            predictedUsedMem = avgUsedMem * m_runningCounter;
         }
+        else if (sampledRunningCounter > 0)
+        {
+            avgUsedMem = sumRunningMem/sampledRunningCounter;
+        }
+        // sampled jobs contribute what they really use, the rest is extrapolated
+        predictedUsedMem = sumRunningMem + avgUsedMem * (m_runningCounter - sampledRunningCounter);
 
         return std::make_tuple(avgRunTime,sumReqMem,predictedUsedMem);
     }
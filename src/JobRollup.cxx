@@ -0,0 +1,209 @@
+#include "JobRollup.hxx"
+
+namespace SJM
+{
+    JobRollup::JobRollup() noexcept : m_contributions({}), m_nodeStats({}), m_partitionStats({}), m_totalStats(), m_candidateNodes({}), m_settledNodes(0)
+    {
+    }
+
+    void JobRollup::Update(const std::vector<Job> &jobVec, const std::set<std::pair<unsigned long,unsigned long> > &changedKeys)
+    {
+        for (const auto &key : changedKeys)
+        {
+            auto job = std::lower_bound(jobVec.begin(),jobVec.end(),key,[](const Job &lhs, const std::pair<unsigned long,unsigned long> &rhs)
+            {
+                return std::make_pair(lhs.GetJobId(),lhs.GetTaskId()) < rhs;
+            });
+
+            if (job != jobVec.end() && job->GetJobId() == key.first && job->GetTaskId() == key.second)
+                Upsert(key,*job);
+            else
+                Remove(key);
+        }
+    }
+
+    void JobRollup::Rebuild(const std::vector<Job> &jobVec)
+    {
+        m_contributions.clear();
+        m_nodeStats.clear();
+        m_partitionStats.clear();
+        m_totalStats = GroupStats();
+        m_candidateNodes.clear();
+        m_settledNodes = 0;
+
+        for (const Job &job : jobVec)
+            Upsert(std::make_pair(job.GetJobId(),job.GetTaskId()),job);
+    }
+
+    void JobRollup::Upsert(const std::pair<unsigned long,unsigned long> &key, const Job &job)
+    {
+        Contribution contribution = MakeContribution(job);
+        auto [it,inserted] = m_contributions.try_emplace(key,contribution);
+        if (inserted)
+        {
+            Apply(contribution,1);
+        }
+        else if (!(it->second == contribution))
+        {
+            Apply(it->second,-1);
+            Apply(contribution,1);
+            it->second = std::move(contribution);
+        }
+    }
+
+    void JobRollup::Remove(const std::pair<unsigned long,unsigned long> &key)
+    {
+        auto it = m_contributions.find(key);
+        if (it == m_contributions.end())
+            return;
+
+        Apply(it->second,-1);
+        m_contributions.erase(it);
+    }
+
+    std::vector<HotNode> JobRollup::GetHotNodes(std::size_t maxNodes) const
+    {
+        std::vector<HotNode> hotNodes;
+        const double overallRate = std::clamp(m_totalStats.GetFailureRate(),0.01,0.99); // keeps the test meaningful when (almost) nothing or everything fails
+        const double threshold = m_falseAlarmRate / static_cast<double>(std::max<std::size_t>(m_settledNodes,1)); // every tested node gets a chance to be flagged by accident
+
+        for (const std::string &node : m_candidateNodes)
+        {
+            const GroupStats &stats = m_nodeStats.at(node);
+            const std::size_t nSettled = stats.GetSettledCount();
+            const double rate = stats.GetFailureRate();
+            if (rate <= overallRate || BinomialTail(stats.nFailed,nSettled,overallRate) > threshold)
+                continue;
+
+            auto topReason = std::max_element(stats.failureReasons.begin(),stats.failureReasons.end(),[](const auto &lhs, const auto &rhs){return lhs.second < rhs.second;});
+            hotNodes.push_back({node,(topReason != stats.failureReasons.end()) ? topReason->first : "",stats.nFailed,nSettled,rate});
+        }
+
+        std::sort(hotNodes.begin(),hotNodes.end(),[](const HotNode &lhs, const HotNode &rhs)
+        {
+            return std::make_pair(lhs.failureRate,lhs.nFailed) > std::make_pair(rhs.failureRate,rhs.nFailed);
+        });
+        if (hotNodes.size() > maxNodes)
+            hotNodes.resize(maxNodes);
+
+        return hotNodes;
+    }
+
+    JobRollup::Contribution JobRollup::MakeContribution(const Job &job) const
+    {
+        const bool failed = IsNodeFailure(job.GetState());
+        return {
+            job.GetState(),
+            job.GetPartition(),
+            failed,
+            job.GetNode(),
+            failed ? MakeFailureReason(job) : "",
+            job.IsActive() ? std::chrono::seconds(0) : job.GetElapsedTime(),
+            job.GetUsedMem()
+        };
+    }
+
+    void JobRollup::Apply(const Contribution &contribution, int sign)
+    {
+        ApplyToGroup(m_totalStats,contribution,sign);
+        auto partitionStats = m_partitionStats.try_emplace(contribution.partition).first;
+        ApplyToGroup(partitionStats->second,contribution,sign);
+        if (partitionStats->second.IsEmpty())
+            m_partitionStats.erase(partitionStats);
+
+        if (!HasNode(contribution))
+            return;
+
+        auto nodeStats = m_nodeStats.try_emplace(contribution.node).first;
+        const bool wasSettled = nodeStats->second.GetSettledCount() > 0;
+        ApplyToGroup(nodeStats->second,contribution,sign);
+        const bool isSettled = nodeStats->second.GetSettledCount() > 0;
+        if (isSettled != wasSettled)
+            isSettled ? ++m_settledNodes : --m_settledNodes;
+
+        if (nodeStats->second.nFailed >= m_minFailures)
+            m_candidateNodes.insert(contribution.node);
+        else
+            m_candidateNodes.erase(contribution.node);
+
+        if (nodeStats->second.IsEmpty())
+            m_nodeStats.erase(nodeStats);
+    }
+
+    void JobRollup::ApplyToGroup(GroupStats &group, const Contribution &contribution, int sign) const
+    {
+        auto count = [sign](std::size_t &counter){counter = (sign > 0) ? counter + 1 : counter - 1;};
+
+        count(group.stateCounts.at(static_cast<std::size_t>(contribution.state)));
+        if (contribution.state == Job::State::Completed)
+            count(group.nCompleted);
+
+        if (contribution.failed)
+        {
+            count(group.nFailed);
+            auto reason = group.failureReasons.try_emplace(contribution.reason,0).first;
+            count(reason->second);
+            if (reason->second == 0)
+                group.failureReasons.erase(reason);
+        }
+        if (contribution.runTime.count() > 0)
+        {
+            count(group.nWithRunTime);
+            group.sumRunTime += sign * contribution.runTime;
+        }
+        if (contribution.usedMemory > 0)
+        {
+            count(group.nWithMemory);
+            group.sumUsedMem += sign * static_cast<double>(contribution.usedMemory);
+        }
+    }
+
+    double JobRollup::BinomialTail(std::size_t k, std::size_t n, double p) const noexcept
+    {
+        double tail = 0;
+        for (std::size_t i = k; i <= n; ++i)
+        {
+            const double di = static_cast<double>(i), dn = static_cast<double>(n);
+            tail += std::exp(std::lgamma(dn + 1) - std::lgamma(di + 1) - std::lgamma(dn - di + 1) + di * std::log(p) + (dn - di) * std::log1p(-p));
+        }
+
+        return std::min(tail,1.);
+    }
+
+    std::string JobRollup::MakeFailureReason(const Job &job) const
+    {
+        // the state reason of a finished job is mostly the leftover "None" from scheduling, so the final state and exit status say more, e.g. "FAILED/ERROR"
+        std::string reason = job.GetStateName();
+        const std::string exitStatus = job.GetExitCodeStatus();
+        if (!exitStatus.empty() && exitStatus != "SUCCESS")
+            reason += "/" + exitStatus;
+
+        const std::string stateReason = job.GetStateReason();
+        if (!stateReason.empty() && stateReason != "None")
+            reason += " (" + stateReason + ")";
+
+        return reason;
+    }
+
+    bool JobRollup::IsNodeFailure(Job::State state) const noexcept
+    {
+        switch (state)
+        {
+            case Job::State::Failed :
+            case Job::State::NodeFail :
+            case Job::State::OutOfMemory :
+            case Job::State::Timeout :
+            case Job::State::BootFail :
+                return true;
+
+            default: // cancelled, preempted, revoked and deadline jobs were stopped by the user or the scheduler, the node has nothing to do with it
+                return false;
+        }
+    }
+
+    bool JobRollup::HasNode(const Contribution &contribution) const noexcept
+    {
+        return contribution.state != Job::State::Pending && !contribution.node.empty() && contribution.node != "None assigned";
+    }
+
+} // namespace SJM
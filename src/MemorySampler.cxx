@@ -0,0 +1,142 @@
+#include "MemorySampler.hxx"
+
+namespace SJM
+{
+    MemorySampler::MemorySampler(std::size_t budget, std::size_t batchSize, std::size_t maxConcurrent) noexcept :
+    m_budget(budget), m_batchSize(std::max<std::size_t>(batchSize,1)), m_maxConcurrent(std::max<std::size_t>(maxConcurrent,1)), m_unparsedLines(0), m_lastSampled(0,0), m_samples({})
+    {
+    }
+
+    const std::map<std::pair<unsigned long,unsigned long>,unsigned long>& MemorySampler::Sample(const std::vector<Job> &jobVec)
+    {
+        std::vector<std::pair<unsigned long,unsigned long> > running;
+        std::map<unsigned long,std::pair<unsigned long,unsigned long> > rawJobIds;
+        for (const Job &job : jobVec)
+        {
+            if (job.GetState() != Job::State::Running)
+                continue;
+
+            running.emplace_back(job.GetJobId(),job.GetTaskId());
+            rawJobIds.try_emplace(job.GetRawJobId(),job.GetJobId(),job.GetTaskId());
+        }
+        m_unparsedLines = 0;
+        std::sort(running.begin(),running.end());
+
+        // samples of tasks which are not running anymore would only skew the estimate
+        std::erase_if(m_samples,[&running](const auto &sample){return !std::binary_search(running.begin(),running.end(),sample.first);});
+        if (running.empty())
+            return m_samples;
+
+        const std::size_t nSelected = std::min(m_budget,running.size());
+        const std::size_t start = std::upper_bound(running.begin(),running.end(),m_lastSampled) - running.begin();
+        std::vector<std::pair<unsigned long,unsigned long> > selected;
+        selected.reserve(nSelected);
+        for (std::size_t i = 0; i < nSelected; ++i)
+            selected.push_back(running[(start + i) % running.size()]);
+
+        if (selected.empty())
+            return m_samples;
+
+        m_lastSampled = selected.back();
+
+        // batches are run in waves, so there are never more than m_maxConcurrent sstat calls hitting slurmctld at once
+        const std::size_t waveSize = m_batchSize * m_maxConcurrent;
+        for (std::size_t first = 0; first < selected.size(); first += waveSize)
+        {
+            std::vector<std::future<std::tuple<std::map<std::pair<unsigned long,unsigned long>,unsigned long>,std::size_t> > > wave;
+            for (std::size_t b = first; b < std::min(first + waveSize,selected.size()); b += m_batchSize)
+            {
+                std::vector<std::pair<unsigned long,unsigned long> > batch(selected.begin() + b,selected.begin() + std::min(b + m_batchSize,selected.size()));
+                wave.push_back(std::async(std::launch::async,&MemorySampler::ExecuteBatch,this,std::move(batch),std::cref(rawJobIds)));
+            }
+            for (auto &result : wave)
+            {
+                auto [samples,unparsed] = result.get();
+                for (const auto &[key,maxRss] : samples)
+                    m_samples.insert_or_assign(key,maxRss);
+                m_unparsedLines += unparsed;
+            }
+        }
+
+        return m_samples;
+    }
+
+    std::tuple<std::map<std::pair<unsigned long,unsigned long>,unsigned long>,std::size_t> MemorySampler::ExecuteBatch(const std::vector<std::pair<unsigned long,unsigned long> > &batch, 
+        const std::map<unsigned long,std::pair<unsigned long,unsigned long> > &rawJobIds) const
+    {
+        std::map<std::pair<unsigned long,unsigned long>,unsigned long> samples;
+        std::size_t unparsed = 0;
+        std::string jobList;
+        for (const auto &[jobId,taskId] : batch)
+            jobList += std::to_string(jobId) + "_" + std::to_string(taskId) + ",";
+
+        // several batches run at the same time, so the output is read through a pipe instead of a shared file
+        std::string command = "sstat -a -n -P -o JobID,MaxRSS -j " + jobList + " 2> /dev/null";
+        FILE *pipe = popen(command.data(),"r");
+        if (pipe == nullptr)
+            return std::make_tuple(std::move(samples),unparsed);
+
+        std::array<char,256> line;
+        std::array<char,64> maxRss;
+        while (std::fgets(line.data(),line.size(),pipe) != nullptr)
+        {
+            unsigned long jobId = 0, taskId = 0;
+            // one line per job step, e.g. "1234_5.batch|1048576K", the task uses as much as its largest step
+            int nRead = std::sscanf(line.data(),"%lu_%lu.%*[^|]|%63s",&jobId,&taskId,maxRss.data());
+            if (nRead < 2) // the step may also be reported under the raw job id of the task, e.g. "1240.batch|1048576K"
+            {
+                unsigned long rawJobId = 0;
+                nRead = std::sscanf(line.data(),"%lu.%*[^|]|%63s",&rawJobId,maxRss.data());
+                auto task = rawJobIds.find(rawJobId);
+                if (nRead < 1 || task == rawJobIds.end())
+                {
+                    ++unparsed;
+                    continue;
+                }
+                std::tie(jobId,taskId) = task->second;
+                ++nRead;
+            }
+            if (nRead < 3) // the step has not reported its MaxRSS yet
+                continue;
+
+            unsigned long &taskMaxRss = samples[{jobId,taskId}];
+            taskMaxRss = std::max(taskMaxRss,ParseMemory(maxRss.data()));
+        }
+        pclose(pipe);
+
+        return std::make_tuple(std::move(samples),unparsed);
+    }
+
+    unsigned long MemorySampler::ParseMemory(const std::string &str) const
+    {
+        std::size_t pos = 0;
+        double value = 0;
+        try
+        {
+            value = std::stod(str,&pos);
+        }
+        catch (const std::exception &)
+        {
+            return 0;
+        }
+
+        switch ((pos < str.size()) ? str[pos] : 'K') // sstat reports kilobytes unless a different unit is given
+        {
+            case 'K' :
+                return static_cast<unsigned long>(value * 1024);
+
+            case 'M' :
+                return static_cast<unsigned long>(value * 1024 * 1024);
+
+            case 'G' :
+                return static_cast<unsigned long>(value * 1024 * 1024 * 1024);
+
+            case 'T' :
+                return static_cast<unsigned long>(value * 1024 * 1024 * 1024 * 1024);
+
+            default:
+                return static_cast<unsigned long>(value);
+        }
+    }
+
+} // namespace SJM